@@ -0,0 +1,142 @@
+//  Lexing lots of small headers: a Tokenize() call per file with keyword arrays against TokenizeBatch() with a shared KeywordTable,
+//  from memory and from files that TokenizeBatch() maps itself.
+//
+//  Build: g++ -O2 -std=c++11 -pthread -I.. batch_bench.cpp -o batch_bench
+//  Usage: batch_bench [number of files, default 20000]
+//
+#define GENERIC_LEXER_ENABLE_THREADS
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace generic_lexer;
+
+/** Where the mapped run writes its files: TMPDIR (TEMP on Windows) or the working directory */
+static std::string TempPath(uint32_t index)
+{
+    const char* directory = std::getenv("TMPDIR");
+    directory = directory ? directory : std::getenv("TEMP");
+    return std::string(directory ? directory : ".") + "/generic_lexer_batch_bench_" + std::to_string(index) + ".h";
+}
+
+/** Total tokens over all files, fails on any file that didn't lex or disagrees with the per file Tokenize() */
+static bool CheckBatch(const std::vector<BatchFile>& files, const std::vector<uint32_t>& expectedTokens, const char* what)
+{
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i].status != BATCH_OK || files[i].numTokens != expectedTokens[i]) {
+            std::printf("%s: file %zu has status %d and %u tokens, expected %u\n", what, i, (int)files[i].status, files[i].numTokens, expectedTokens[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t numFiles = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const uint32_t NUM_MAPPED_FILES = 2000;
+
+    Generator gen(1);
+    std::vector<std::vector<char>> buffers(numFiles);
+    size_t totalSize = 0;
+    size_t maxSize = 0;
+    for (std::vector<char>& buffer : buffers) {
+        std::string header = Header(&gen);
+        buffer.assign(header.begin(), header.end());
+        buffer.push_back('\0');
+        totalSize += header.size();
+        maxSize = header.size() > maxSize ? header.size() : maxSize;
+    }
+
+    const TokenType* keywordTypes = KeywordTypes();
+    KeywordTable keywordTable;
+    if (!keywordTable.Build(KEYWORDS, keywordTypes, NUM_KEYWORDS)) {
+        std::printf("can't build the keyword table\n");
+        return 1;
+    }
+
+    // the README way: a fresh lexer and keyword arrays per file, the token buffer is reused like a consumer that copies out would
+    std::vector<Token> tokens(maxSize + 1);
+    std::vector<uint32_t> expectedTokens(numFiles);
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < numFiles; ++i) {
+        Lexer lexer;
+        Tokenize(&lexer, buffers[i].data(), (uint32_t)(buffers[i].size() - 1), tokens.data(), (uint32_t)(tokens.size() * sizeof(Token)), Lexer::Flags::SKIP_ALL_COMMENTS,
+            KEYWORDS, keywordTypes, NUM_KEYWORDS);
+        expectedTokens[i] = lexer._numTokens;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%u files, %zu KB\n", numFiles, totalSize >> 10);
+    std::printf("Tokenize() per file        %8.1f MB/s\n", totalSize / seconds / 1e6);
+
+    uint32_t maxThreads = std::thread::hardware_concurrency();
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+    for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        std::vector<BatchFile> files(numFiles);
+        for (auto i = 0u; i < numFiles; ++i) {
+            files[i].buffer = buffers[i].data();
+            files[i].bufferSize = (uint32_t)(buffers[i].size() - 1);
+        }
+        std::vector<RecyclingAllocator> heaps(numThreads);
+        std::vector<Allocator*> allocators;
+        for (RecyclingAllocator& heap : heaps) {
+            allocators.push_back(&heap);
+        }
+
+        start = std::chrono::steady_clock::now();
+        bool success = TokenizeBatch(files.data(), numFiles, allocators.data(), numThreads, Lexer::Flags::SKIP_ALL_COMMENTS, &keywordTable);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!success || !CheckBatch(files, expectedTokens, "TokenizeBatch()")) {
+            return 1;
+        }
+        std::printf("TokenizeBatch() %2u threads %8.1f MB/s\n", numThreads, totalSize / seconds / 1e6);
+    }
+
+    // the first files again, written out and mapped by TokenizeBatch() through BatchFile::path
+    uint32_t numMapped = NUM_MAPPED_FILES < numFiles ? NUM_MAPPED_FILES : numFiles;
+    std::vector<std::string> paths(numMapped);
+    size_t mappedSize = 0;
+    bool written = true;
+    for (auto i = 0u; i < numMapped && written; ++i) {
+        paths[i] = TempPath(i);
+        FILE* file = std::fopen(paths[i].c_str(), "wb");
+        size_t size = buffers[i].size() - 1;
+        written = file && std::fwrite(buffers[i].data(), 1, size, file) == size;
+        written = file && std::fclose(file) == 0 && written;
+        mappedSize += size;
+    }
+    bool success = written;
+    if (written) {
+        std::vector<BatchFile> files(numMapped);
+        for (auto i = 0u; i < numMapped; ++i) {
+            files[i].path = paths[i].c_str();
+        }
+        std::vector<RecyclingAllocator> heaps(maxThreads);
+        std::vector<Allocator*> allocators;
+        for (RecyclingAllocator& heap : heaps) {
+            allocators.push_back(&heap);
+        }
+        start = std::chrono::steady_clock::now();
+        success = TokenizeBatch(files.data(), numMapped, allocators.data(), maxThreads, Lexer::Flags::SKIP_ALL_COMMENTS, &keywordTable);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        success = success && CheckBatch(files, std::vector<uint32_t>(expectedTokens.begin(), expectedTokens.begin() + numMapped), "mapped TokenizeBatch()");
+        UnmapBatch(files.data(), numMapped);
+        if (success) {
+            std::printf("TokenizeBatch() mapped     %8.1f MB/s  (%u files, %zu KB, %u threads)\n", mappedSize / seconds / 1e6, numMapped, mappedSize >> 10, maxThreads);
+        }
+    }
+    else {
+        std::printf("can't write the files for the mapped run to %s\n", TempPath(0).c_str());
+    }
+    for (const std::string& path : paths) {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+//  What the benches share: synthetic corpora generated a line at a time, the keyword set, an allocator for the token arenas and token comparison.
+//
+#pragma once
+
+#include "../GENERIC_LEXER.H"
+
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+static const char* KEYWORDS[] = {
+    "auto", "bool", "break", "case", "char", "class", "const", "continue", "default", "delete", "do", "double", "else", "enum",
+    "extern", "false", "float", "for", "if", "inline", "int", "long", "namespace", "new", "nullptr", "private", "public", "return",
+    "short", "signed", "sizeof", "static", "struct", "switch", "template", "this", "true", "typedef", "typename", "union", "unsigned",
+    "using", "virtual", "void", "volatile", "while"
+};
+static const uint32_t NUM_KEYWORDS = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+
+static const char* WORDS[] = {
+    "value", "count", "index", "buffer", "result", "context", "position", "length", "first", "second", "node", "parent",
+    "child", "table", "entry", "lexer", "token", "stream", "offset", "state", "size", "data", "item", "list"
+};
+static const uint32_t NUM_WORDS = sizeof(WORDS) / sizeof(WORDS[0]);
+
+/** Token types for KEYWORDS, in order, right behind the default ones */
+inline const generic_lexer::TokenType* KeywordTypes()
+{
+    static generic_lexer::TokenType types[NUM_KEYWORDS];
+    for (auto i = 0u; i < NUM_KEYWORDS; ++i) {
+        types[i] = generic_lexer::DefaultToken::LAST_TYPE + i;
+    }
+    return types;
+}
+
+struct Generator
+{
+    std::mt19937 rng;
+
+    explicit Generator(uint32_t seed = 1) : rng(seed) {}
+
+    uint32_t Next(uint32_t range) { return rng() % range; }
+
+    std::string Identifier()
+    {
+        std::string identifier = WORDS[Next(NUM_WORDS)];
+        for (auto i = Next(3); i > 0; --i) {
+            std::string word = WORDS[Next(NUM_WORDS)];
+            if (Next(2)) {
+                identifier += "_" + word;
+            }
+            else {
+                word[0] = (char)(word[0] - 'a' + 'A');
+                identifier += word;
+            }
+        }
+        return identifier;
+    }
+
+    std::string Keyword() { return KEYWORDS[Next(NUM_KEYWORDS)]; }
+
+    /** Random letters, mostly not a word of any language */
+    std::string Letters(uint32_t minLength, uint32_t maxLength)
+    {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        std::string letters(minLength + Next(maxLength - minLength + 1), ' ');
+        for (auto& c : letters) {
+            c = alphabet[Next(sizeof(alphabet) - 1)];
+        }
+        return letters;
+    }
+
+    /** Plain words, no quotes or backslashes so it lexes with any flags when comments aren't skipped */
+    std::string Sentence(uint32_t minWords, uint32_t maxWords)
+    {
+        std::string sentence;
+        for (auto i = minWords + Next(maxWords - minWords + 1); i > 0; --i) {
+            sentence += WORDS[Next(NUM_WORDS)];
+            sentence += i > 1 ? (Next(8) == 0 ? ", " : " ") : ".";
+        }
+        return sentence;
+    }
+
+    std::string Number()
+    {
+        switch (Next(6)) {
+            case 0:  return std::to_string(Next(100));
+            case 1:  return std::to_string(Next(1000000)) + "u";
+            case 2:  return std::to_string(Next(100)) + "." + std::to_string(Next(1000)) + "f";
+            case 3:  return "." + std::to_string(Next(100)) + "f";
+            case 4:  return std::to_string(Next(10)) + "." + std::to_string(Next(100000));
+            default: return "0x" + std::to_string(Next(100));
+        }
+    }
+};
+
+/** Produces one line of a synthetic corpus */
+typedef std::string (*LineFunction)(Generator* gen);
+
+inline std::string IdentifierLine(Generator* gen)
+{
+    switch (gen->Next(4)) {
+        case 0:  return "    " + gen->Keyword() + " " + gen->Identifier() + " = " + gen->Identifier() + "(" + gen->Identifier() + ", " + gen->Identifier() + "->" + gen->Identifier() + ");\n";
+        case 1:  return "    if (" + gen->Identifier() + " && !" + gen->Identifier() + ") { return " + gen->Identifier() + "." + gen->Identifier() + "; }\n";
+        case 2:  return "    for (" + gen->Keyword() + " " + gen->Identifier() + " = " + gen->Identifier() + "; " + gen->Identifier() + " < " + gen->Identifier() + "; " + gen->Identifier() + "++) {\n";
+        default: return "    " + gen->Identifier() + "::" + gen->Identifier() + "(" + gen->Identifier() + ", " + gen->Keyword() + ", " + gen->Identifier() + ");\n";
+    }
+}
+
+inline std::string CommentLine(Generator* gen)
+{
+    switch (gen->Next(4)) {
+        case 0:  return "    // " + gen->Sentence(4, 12) + "\n";
+        case 1:  return "    /* " + gen->Sentence(4, 10) + "\n     * " + gen->Sentence(4, 10) + "\n     */\n";
+        case 2:  return "    /** " + gen->Sentence(2, 6) + " /* nested */ " + gen->Sentence(2, 6) + " */\n";
+        default: return "    " + gen->Identifier() + " = " + gen->Identifier() + ";    // " + gen->Sentence(3, 8) + "\n";
+    }
+}
+
+inline std::string NumericLine(Generator* gen)
+{
+    std::string line = "    " + gen->Keyword() + " " + gen->Identifier() + "[] = { " + gen->Number();
+    for (auto i = 3 + gen->Next(8); i > 0; --i) {
+        line += ", " + gen->Number();
+    }
+    return line + " };\n";
+}
+
+inline std::string StringLine(Generator* gen)
+{
+    switch (gen->Next(3)) {
+        case 0:  return "    print(\"" + gen->Sentence(3, 12) + "\");\n";
+        case 1:  return "    " + gen->Identifier() + " = '" + (char)('a' + gen->Next(26)) + "';\n";
+        default: return "    log(\"" + gen->Sentence(1, 4) + "\", \"" + gen->Sentence(2, 8) + "\", " + gen->Identifier() + ");\n";
+    }
+}
+
+/** Deeply indented code with lots of line comments and comment blocks, roughly like generated sources */
+inline std::string IndentedLine(Generator* gen)
+{
+    uint32_t indent = 4 * gen->Next(8);
+    switch (gen->Next(4)) {
+        case 0: {
+            std::string block = "/*\n";
+            for (auto i = 2 + gen->Next(8); i > 0; --i) {
+                block += std::string(indent, ' ') + " * generated documentation for the item below, describing what it does in some detail\n";
+            }
+            return block + "*/\n";
+        }
+        case 1:  return std::string(indent, ' ') + "// a single line comment explaining the next statement, long enough to span a few blocks\n";
+        case 2:  return std::string(indent, ' ') + "value" + std::to_string(gen->Next(100)) + " = otherValue + 42;\n\n";
+        default: return std::string(indent, '\t') + "if (condition) {\n" + std::string(indent + 4, ' ') + "call(argument);\n" + std::string(indent, ' ') + "}\n";
+    }
+}
+
+/** Nested block comments, line comments and string literals with comment markers and quotes in them. Lex it with comments skipped if strings are produced. */
+inline std::string MixedLine(Generator* gen)
+{
+    switch (gen->Next(6)) {
+        case 0:  return "/* block comment /* nested */ with code in it: int x = \"not a string\"; */\n";
+        case 1:  return "// line comment with a \" quote and a /* that doesn't open anything\n";
+        case 2:  return "    const char* text = \"string literal with // and /* inside\";\n";
+        case 3:  return "    float value" + std::to_string(gen->Next(1000)) + " = 1.5f * (other->member + 0x2A);\n";
+        case 4:  return "    if (a == b && c != d) { return call(argument, 'c'); }\n";
+        default: return "\n";
+    }
+}
+
+/** Expressions with hardly any whitespace, mostly short identifiers and operators */
+inline std::string OperatorLine(Generator* gen)
+{
+    static const char* operators[] = {
+        "+", "-", "*", "/", "=", "==", "!=", "<", "<=", ">", ">=", "&&", "||", "!", "&", "|", "^", "~", "->", "::", ".", ",", ";", ":", "?",
+        "(", ")", "[", "]", "{", "}", "<<", ">>", "+=", "-=", "++", "--", "%", "<<=", "..."
+    };
+    static const char* operands[] = { "a", "b", "i", "x1", "ptr", "n", "v" };
+    std::string line;
+    do {
+        line += operands[gen->Next(sizeof(operands) / sizeof(operands[0]))];
+        for (auto i = 1 + gen->Next(3); i > 0; --i) {
+            line += operators[gen->Next(sizeof(operators) / sizeof(operators[0]))];
+        }
+    } while (gen->Next(16) != 0);
+    return line + "\n";
+}
+
+/** A small generated header, a few dozen inline functions */
+inline std::string Header(Generator* gen)
+{
+    std::string header = "#pragma once\n// generated header\n\nnamespace generated\n{\n";
+    for (auto i = 10 + gen->Next(60); i > 0; --i) {
+        header += "    static inline unsigned int function" + std::to_string(gen->Next(1000)) + "(const char* text, int count)\n    {\n";
+        header += "        if (count > 0 && text != nullptr) { return (unsigned int)count * 31u; }\n        return 0;\n    }\n";
+    }
+    return header + "}\n";
+}
+
+struct Corpus
+{
+    std::string         name;
+    std::string         sizeLabel;  // what was asked for
+    std::vector<char>   data;       // nullterminated
+    uint32_t            size = 0;
+};
+
+/** Whole lines up to the requested size */
+inline void Generate(Corpus* corpus, LineFunction line, uint64_t size, uint32_t seed = 1)
+{
+    Generator gen(seed);
+    corpus->data.clear();
+    corpus->data.reserve(size + 1);
+    for (;;) {
+        std::string text = line(&gen);
+        if (corpus->data.size() + text.size() > size) {
+            break;
+        }
+        corpus->data.insert(corpus->data.end(), text.begin(), text.end());
+    }
+    corpus->size = (uint32_t)corpus->data.size();
+    corpus->data.push_back('\0');
+}
+
+/**
+ * Heap allocator that hands out the same blocks again after Rewind(), every run makes the same requests.
+ * Keeps page faults on fresh memory out of the timings when it's rewound between runs, frees everything in the end.
+ */
+struct RecyclingAllocator : generic_lexer::Allocator
+{
+    struct Block
+    {
+        void*   memory;
+        size_t  size;
+    };
+    std::vector<Block> blocks;
+    size_t next = 0;
+
+    void* Allocate(size_t size, size_t alignment) override
+    {
+        // malloc aligns for any fundamental type and no further, anything stricter counts as running out
+        if (alignment > alignof(std::max_align_t)) {
+            return nullptr;
+        }
+        if (next < blocks.size() && blocks[next].size >= size) {
+            return blocks[next++].memory;
+        }
+        void* memory = std::malloc(size);
+        if (!memory) {
+            return nullptr;
+        }
+        blocks.insert(blocks.begin() + next, Block{ memory, size });
+        return blocks[next++].memory;
+    }
+
+    void Rewind()
+    {
+        next = 0;
+    }
+
+    ~RecyclingAllocator()
+    {
+        for (Block& block : blocks) {
+            std::free(block.memory);
+        }
+    }
+};
+
+inline bool SameToken(const generic_lexer::Token& a, const generic_lexer::Token& b)
+{
+    return a.type == b.type && a.text.buffer == b.text.buffer && a.text.length == b.text.length && a.lineNumber == b.lineNumber;
+}
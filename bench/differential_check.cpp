@@ -0,0 +1,366 @@
+//  Differential checks: random inputs lexed through the other entry points of the header have to come out exactly like Tokenize() of the whole
+//  buffer does. The inputs are glued together from pieces that regularly leave literals and comments open, malformed input has to fail the same way.
+//  Half the cases use an operator table with gaps ("..." but no ".."), where a token can depend on more than the next byte.
+//
+//  Build: g++ -O2 -DNDEBUG -std=c++11 -pthread -I.. differential_check.cpp -o differential_check      (the literal asserts fire on malformed input otherwise)
+//  Usage: differential_check stream|sink|compact|parallel|incremental [number of cases, default 10000]
+//
+//  stream:      BeginStream()/Feed()/Next() with random window, chunk and output sizes
+//  sink:        TokenizeInto() a FixedTokenSink of a few tokens and Tokenize() into a buffer that's too small, both drained and Resume()d until done
+//  compact:     CompactTokenSink::GetToken() for every token, with the odd token of about 64K that needs the long length table
+//  parallel:    TokenizeParallel() on 1 to 12 threads, with the minimum chunk size lowered so that short inputs are split as well
+//  incremental: BeginIncremental() and up to 30 random edits passed to Relex(), the tokens after each have to match Tokenize() of the edited text
+//
+#define GENERIC_LEXER_ENABLE_THREADS
+#define GENERIC_LEXER_PARALLEL_MIN_CHUNK_SIZE 8     // split even the shortest inputs
+#include "bench_common.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace generic_lexer;
+
+static const char* PIECES[] = {
+    " ", "\n", "\t", "\n\n    ", "/*", "*/", "//", "\"", "'", "\\", "a", "int", "return", "x_y", "e", "12", "1.5f", ".5", "0x1F",
+    "+", "=", "==", "->", "::", ".", ";", "{", "}", "(", "*", "/", "#", "@", "..", "-", "<<", "+-"
+};
+static const uint32_t NUM_PIECES = sizeof(PIECES) / sizeof(PIECES[0]);
+
+enum GappedToken : TokenType
+{
+    ELLIPSIS = DefaultToken::LAST_TYPE + NUM_KEYWORDS,
+    PLUS_MINUS_PLUS_MINUS,
+    SHIFT_LEFT_ASSIGN
+};
+
+/** Operators whose prefixes aren't all operators themselves, Match() has to look past the end of the operator it finds */
+static GENERIC_LEXER_CONSTEXPR14 const OperatorSpec GappedOperators[] = {
+    { "(", DefaultToken::PARENTHESES_OPEN }, { ")", DefaultToken::PARENTHESES_CLOSE }, { "{", DefaultToken::CURLY_BRACES_OPEN }, { "}", DefaultToken::CURLY_BRACES_CLOSE },
+    { ".", DefaultToken::DOT }, { "...", ELLIPSIS }, { ":", DefaultToken::COLON }, { "::", DefaultToken::DOUBLE_COLON }, { ";", DefaultToken::SEMICOLON },
+    { "+", DefaultToken::PLUS }, { "+-+-", PLUS_MINUS_PLUS_MINUS }, { "-", DefaultToken::MINUS }, { "->", DefaultToken::ARROW },
+    { "*", DefaultToken::STAR }, { "/", DefaultToken::SLASH }, { "=", DefaultToken::EQUALS }, { "==", DefaultToken::DOUBLE_EQUALS },
+    { "<", DefaultToken::LESS }, { "<<=", SHIFT_LEFT_ASSIGN }, { "\"", DefaultToken::QUOTATION_MARK }, { "'", DefaultToken::APOSTROPHE }
+};
+static GENERIC_LEXER_CONSTEXPR14 const OperatorDfa GappedOperatorDfa(GappedOperators);
+
+/** Operators that would eat into identifiers, whitespace or literals, each of these tables has to come out invalid */
+static const OperatorSpec LetterOperators[] = { { "+", DefaultToken::PLUS }, { "+a", ELLIPSIS } };
+static const OperatorSpec DigitOperators[] = { { "-1", ELLIPSIS } };
+static const OperatorSpec UnderscoreOperators[] = { { "_", ELLIPSIS } };
+static const OperatorSpec SpaceOperators[] = { { ". .", ELLIPSIS } };
+static const OperatorSpec NewlineOperators[] = { { ";\n", ELLIPSIS } };
+static const OperatorSpec QuoteOperators[] = { { "\"", DefaultToken::QUOTATION_MARK }, { "<\"", ELLIPSIS } };
+
+/** A random input and what Tokenize() makes of it */
+struct Case
+{
+    std::string         text;
+    std::vector<char>   buffer;     // nullterminated
+    Lexer::Flags        flags = Lexer::Flags::NONE;
+    const KeywordTable* keywords = nullptr;
+    const OperatorDfa*  operators = &DefaultOperatorDfa;
+    std::vector<Token>  expected;
+    bool                valid = false;  // Tokenize() got through it
+};
+
+static void Retokenize(Case* c)
+{
+    c->buffer.assign(c->text.begin(), c->text.end());
+    c->buffer.push_back('\0');
+    c->expected.resize(c->text.size() + 2);
+    Lexer lexer;
+    lexer._operators = c->operators;
+    c->valid = Tokenize(&lexer, c->buffer.data(), (uint32_t)c->text.size(), c->expected.data(), (uint32_t)(c->expected.size() * sizeof(Token)), c->flags, c->keywords);
+    c->expected.resize(lexer._numTokens);
+}
+
+static std::string RandomText(Generator* gen, uint32_t maxPieces)
+{
+    std::string text;
+    for (auto i = gen->Next(maxPieces + 1); i > 0; --i) {
+        text += PIECES[gen->Next(NUM_PIECES)];
+    }
+    return text;
+}
+
+/** Same token, the text may live in another buffer */
+static bool SameText(const Token& a, const Token& b)
+{
+    return a.type == b.type && a.lineNumber == b.lineNumber && a.text.length == b.text.length && std::memcmp(a.text.buffer, b.text.buffer, (size_t)a.text.length) == 0;
+}
+
+static bool CheckStream(Case* c, Generator* gen)
+{
+    uint64_t longest = 0;
+    for (const Token& token : c->expected) {
+        longest = token.text.length > longest ? token.text.length : longest;
+    }
+    // skipped line comments have to fit the window as a whole line
+    if (c->flags & Lexer::Flags::SKIP_SINGLE_LINE_COMMENTS) {
+        size_t lineStart = 0;
+        for (size_t i = 0; i <= c->text.size(); ++i) {
+            if (i == c->text.size() || c->text[i] == '\n') {
+                longest = i - lineStart > longest ? i - lineStart : longest;
+                lineStart = i + 1;
+            }
+        }
+    }
+    uint32_t windowSize = 16 + gen->Next(200);
+    windowSize = windowSize < longest + 3 ? (uint32_t)longest + 3 : windowSize;
+    std::vector<char> window(windowSize);
+    std::vector<Token> out(1 + gen->Next(8));
+
+    // tokens point into the window, they're compared before the next Feed() moves it
+    Lexer lexer;
+    lexer._operators = c->operators;
+    BeginStream(&lexer, window.data(), windowSize, c->flags, c->keywords);
+    size_t numTokens = 0;
+    size_t numMatching = 0;
+    size_t fed = 0;
+    StreamStatus status = STREAM_NEED_INPUT;
+    while (status != STREAM_DONE && status != STREAM_ERROR) {
+        if (status == STREAM_NEED_INPUT) {
+            if (fed < c->text.size()) {
+                uint32_t chunkSize = 1 + gen->Next(64);
+                chunkSize = chunkSize < c->text.size() - fed ? chunkSize : (uint32_t)(c->text.size() - fed);
+                fed += Feed(&lexer, c->text.data() + fed, chunkSize);
+            }
+            else {
+                EndStream(&lexer);
+            }
+        }
+        uint32_t numWritten = 0;
+        status = Next(&lexer, out.data(), (uint32_t)out.size(), &numWritten);
+        for (auto i = 0u; i < numWritten; ++i, ++numTokens) {
+            numMatching += numTokens == numMatching && numTokens < c->expected.size() && SameText(out[i], c->expected[numTokens]) ? 1 : 0;
+        }
+    }
+
+    if (c->valid) {
+        return status == STREAM_DONE && numTokens == c->expected.size() && numMatching == numTokens;
+    }
+    // everything up to the token that failed has to match
+    return status == STREAM_ERROR && numTokens <= c->expected.size() + 1 && numMatching + 1 >= numTokens;
+}
+
+/** Tokens written so far against the expected ones, texts have to point to the same place */
+static bool SameTokens(const Case* c, const std::vector<Token>& tokens)
+{
+    if (tokens.size() != c->expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (!SameToken(tokens[i], c->expected[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckSink(Case* c, Generator* gen)
+{
+    const uint32_t maxTokens = 1 + gen->Next(8);
+    std::vector<Token> tokens;
+    Lexer lexer;
+    lexer._operators = c->operators;
+    TokenizeStatus status;
+    if (gen->Next(2)) {
+        // drained with Reset(), now and then a fresh sink takes over
+        std::vector<Token> first(maxTokens), second(maxTokens);
+        FixedTokenSink sinks[] = { FixedTokenSink(first.data(), maxTokens), FixedTokenSink(second.data(), maxTokens) };
+        FixedTokenSink* sink = &sinks[0];
+        status = TokenizeInto(&lexer, c->buffer.data(), (uint32_t)c->text.size(), sink, c->flags, c->keywords);
+        for (;;) {
+            tokens.insert(tokens.end(), sink->_tokens, sink->_tokens + sink->_numTokens);
+            if (status != TOKENIZE_SINK_FULL) {
+                break;
+            }
+            sink->Reset();
+            if (gen->Next(4) == 0) {
+                sink = sink == &sinks[0] ? &sinks[1] : &sinks[0];
+                lexer._tokenSink = sink;
+            }
+            status = Resume(&lexer);
+        }
+    }
+    else {
+        // a token buffer that's too small for Tokenize(), reused from the start for every Resume()
+        std::vector<Token> buffer(maxTokens);
+        bool success = Tokenize(&lexer, c->buffer.data(), (uint32_t)c->text.size(), buffer.data(), maxTokens * (uint32_t)sizeof(Token), c->flags, c->keywords);
+        status = success ? TOKENIZE_DONE : lexer._tokenSinkFull ? TOKENIZE_SINK_FULL : TOKENIZE_ERROR;
+        for (;;) {
+            tokens.insert(tokens.end(), buffer.data(), buffer.data() + lexer._tokenStreamBufferOffset);
+            if (status != TOKENIZE_SINK_FULL) {
+                break;
+            }
+            lexer._tokenStreamBufferOffset = 0;
+            status = Resume(&lexer);
+        }
+    }
+    return status == (c->valid ? TOKENIZE_DONE : TOKENIZE_ERROR) && SameTokens(c, tokens);
+}
+
+static bool CheckCompact(Case* c, Generator* gen)
+{
+    // now and then a token right around the 16 bit length limit, an identifier or a string literal
+    if (gen->Next(32) == 0) {
+        std::string run(CompactTokenSink::LONG_LENGTH - 2 + gen->Next(5), 'x');
+        c->text.insert(gen->Next((uint32_t)c->text.size() + 1), gen->Next(2) ? run : "\"" + run + "\"");
+        Retokenize(c);
+    }
+
+    // enough room for every table, as the sink's documentation says
+    const uint32_t capacity = (uint32_t)c->text.size() + 1;
+    std::vector<TokenType> types(capacity);
+    std::vector<uint32_t> offsets(capacity);
+    std::vector<uint16_t> lengths(capacity);
+    std::vector<CompactTokenSink::LineStart> lines(capacity);
+    std::vector<CompactTokenSink::LongLength> longLengths(capacity);
+    CompactTokenSink sink(c->buffer.data(), types.data(), offsets.data(), lengths.data(), capacity, lines.data(), capacity, longLengths.data(), capacity);
+
+    Lexer lexer;
+    lexer._operators = c->operators;
+    TokenizeStatus status = TokenizeInto(&lexer, c->buffer.data(), (uint32_t)c->text.size(), &sink, c->flags, c->keywords);
+    std::vector<Token> tokens(sink._numTokens);
+    for (auto i = 0u; i < sink._numTokens; ++i) {
+        tokens[i] = sink.GetToken(i);
+    }
+    return status == (c->valid ? TOKENIZE_DONE : TOKENIZE_ERROR) && SameTokens(c, tokens);
+}
+
+static bool CheckParallel(Case* c, Generator* gen)
+{
+    const uint32_t numThreads = 1 + gen->Next(12);
+    RecyclingAllocator allocators[12];
+    Allocator* threadAllocators[12];
+    for (auto i = 0u; i < numThreads; ++i) {
+        threadAllocators[i] = &allocators[i];
+    }
+    ArenaTokenSink out;
+    if (!TokenizeParallel(c->buffer.data(), (uint32_t)c->text.size(), &out, threadAllocators, numThreads, c->flags, c->keywords, c->operators)) {
+        return !c->valid;
+    }
+    std::vector<Token> tokens(out._numTokens);
+    out.CopyTo(tokens.data());
+    return c->valid && SameTokens(c, tokens);
+}
+
+/** Replaces removed bytes at offset with inserted */
+struct Edit
+{
+    uint32_t    offset;
+    uint32_t    removed;
+    std::string inserted;
+};
+
+static bool CheckIncremental(Case* c, Generator* gen)
+{
+    // remove a few bytes and insert a piece or two (or a single character) somewhere, the edits are made up front to size the token storage
+    std::vector<Edit> edits(1 + gen->Next(30));
+    Case edited = *c;
+    size_t maxTokens = edited.expected.size();
+    for (Edit& edit : edits) {
+        edit.offset = gen->Next((uint32_t)edited.text.size() + 1);
+        edit.removed = gen->Next(3) == 0 ? 0 : gen->Next((uint32_t)std::min<size_t>(8, edited.text.size() - edit.offset + 1));
+        edit.inserted = gen->Next(3) == 0 ? "" : RandomText(gen, 2);
+        edit.inserted = gen->Next(4) == 0 ? std::string(1, "ab/*\"\n =."[gen->Next(10)]) : edit.inserted;
+        edited.text.replace(edit.offset, edit.removed, edit.inserted);
+        Retokenize(&edited);
+        maxTokens = std::max(maxTokens, edited.expected.size());
+    }
+
+    // no more room than the longest token stream needs, the old tokens behind an edit have to make room for the new ones. With three checkpoints
+    // they get thinned out all the time.
+    const uint32_t capacity = (uint32_t)maxTokens;
+    std::vector<IncrementalLexer::StoredToken> storage(capacity);
+    std::vector<IncrementalLexer::Checkpoint> checkpoints(gen->Next(2) ? capacity : 3);
+    IncrementalLexer incremental;
+    incremental._lexer._operators = c->operators;
+    TokenizeStatus status = BeginIncremental(&incremental, c->buffer.data(), (uint32_t)c->text.size(), storage.data(), capacity, checkpoints.data(), (uint32_t)checkpoints.size(),
+        c->flags, c->keywords);
+    for (auto i = 0u; ; ++i) {
+        std::vector<Token> tokens(incremental.NumTokens());
+        for (auto j = 0u; j < incremental.NumTokens(); ++j) {
+            tokens[j] = incremental.GetToken(j);
+        }
+        if (status != (c->valid ? TOKENIZE_DONE : TOKENIZE_ERROR) || !SameTokens(c, tokens)) {
+            return false;
+        }
+        if (i == edits.size()) {
+            return true;
+        }
+        // Retokenize() moves the buffer
+        const Edit& edit = edits[i];
+        c->text.replace(edit.offset, edit.removed, edit.inserted);
+        Retokenize(c);
+        status = Relex(&incremental, c->buffer.data(), (uint32_t)c->text.size(), edit.offset, edit.removed, (uint32_t)edit.inserted.size());
+    }
+}
+
+struct Check
+{
+    const char* name;
+    bool      (*run)(Case* c, Generator* gen);
+};
+
+static const Check CHECKS[] = {
+    { "stream",      CheckStream },
+    { "sink",        CheckSink },
+    { "compact",     CheckCompact },
+    { "parallel",    CheckParallel },
+    { "incremental", CheckIncremental }
+};
+
+int main(int argc, char** argv)
+{
+    const Check* check = nullptr;
+    for (const Check& candidate : CHECKS) {
+        check = argc > 1 && std::strcmp(argv[1], candidate.name) == 0 ? &candidate : check;
+    }
+    if (!check) {
+        std::printf("usage: differential_check <check> [number of cases], the checks are:");
+        for (const Check& candidate : CHECKS) {
+            std::printf(" %s", candidate.name);
+        }
+        std::printf("\n");
+        return 2;
+    }
+    const uint32_t numCases = argc > 2 ? std::atoi(argv[2]) : 10000;
+    if (!GappedOperatorDfa._valid) {
+        std::printf("gapped operators don't fit the DFA limits\n");
+        return 1;
+    }
+    if (OperatorDfa(LetterOperators)._valid || OperatorDfa(DigitOperators)._valid || OperatorDfa(UnderscoreOperators)._valid
+        || OperatorDfa(SpaceOperators)._valid || OperatorDfa(NewlineOperators)._valid || OperatorDfa(QuoteOperators)._valid) {
+        std::printf("an operator table that isn't punctuation only was taken as valid\n");
+        return 1;
+    }
+
+    static KeywordTable keywordTable;
+    if (!keywordTable.Build(KEYWORDS, KeywordTypes(), NUM_KEYWORDS)) {
+        std::printf("can't build the keyword table\n");
+        return 1;
+    }
+
+    Generator gen(1);
+    uint32_t numInvalid = 0;
+    for (auto i = 0u; i < numCases; ++i) {
+        Case c;
+        c.text = RandomText(&gen, 200);
+        c.flags = Lexer::Flags(gen.Next(32) << 1);     // any combination of the five flag bits
+        c.keywords = gen.Next(2) ? &keywordTable : nullptr;
+        c.operators = gen.Next(2) ? &GappedOperatorDfa : &DefaultOperatorDfa;
+        Retokenize(&c);
+        numInvalid += c.valid ? 0 : 1;
+        if (!check->run(&c, &gen)) {
+            std::printf("%s: case %u with flags 0x%02x differs from Tokenize()\n---\n%s\n---\n", check->name, i, (unsigned)c.flags, c.text.c_str());
+            return 1;
+        }
+    }
+    std::printf("%s: %u cases agree with Tokenize(), %u of them malformed\n", check->name, numCases, numInvalid);
+    return 0;
+}
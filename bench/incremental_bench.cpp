@@ -0,0 +1,102 @@
+//  Re-lex latency for single character edits in a 2 MB file: Tokenize() of the whole file against Relex().
+//  Edits that open a comment or string literal still re-lex up to wherever that ends, the words typed here don't.
+//
+//  Build: g++ -O2 -std=c++11 -I.. incremental_bench.cpp -o incremental_bench
+//  Usage: incremental_bench [file size in KB, default 2048] [number of edits, default 2000]
+//
+#include "bench_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace generic_lexer;
+
+int main(int argc, char** argv)
+{
+    const uint32_t sourceSize = (argc > 1 ? std::atoi(argv[1]) : 2048) << 10;
+    const uint32_t maxEdits = argc > 2 ? std::atoi(argv[2]) : 2000;
+    const Lexer::Flags flags = Lexer::Flags::SKIP_ALL_COMMENTS;
+
+    Corpus source;
+    Generate(&source, MixedLine, sourceSize);
+    std::string text(source.data.data(), source.size);
+    std::vector<char> buffer(text.begin(), text.end());
+    buffer.push_back('\0');
+
+    // full re-tokenization, what every keystroke costs without incremental mode
+    std::vector<Token> tokens(text.size() + 1);
+    double fullSeconds = 1e30;
+    for (int run = 0; run < 5; ++run) {
+        Lexer lexer;
+        auto start = std::chrono::steady_clock::now();
+        Tokenize(&lexer, buffer.data(), (uint32_t)text.size(), tokens.data(), (uint32_t)(tokens.size() * sizeof(Token)), flags);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fullSeconds = seconds < fullSeconds ? seconds : fullSeconds;
+    }
+
+    std::vector<IncrementalLexer::StoredToken> storedTokens(text.size() + 1024);
+    std::vector<IncrementalLexer::Checkpoint> checkpoints(storedTokens.size() / IncrementalLexer::CHECKPOINT_INTERVAL + 1024);
+    IncrementalLexer incremental;
+    BeginIncremental(&incremental, buffer.data(), (uint32_t)text.size(), storedTokens.data(), (uint32_t)storedTokens.size(), checkpoints.data(), (uint32_t)checkpoints.size(), flags);
+
+    // typing: a word is typed in somewhere and then deleted again with backspace, the cursor wanders through the file
+    Generator gen(2);
+    const char* words[] = { "x", "value", "call(a, b);", "+ 1", "if (a == b) {", "ptr->member" };
+    std::vector<double> times;
+    uint32_t numEdits = 0;
+    while (numEdits < maxEdits) {
+        uint32_t cursor = gen.Next((uint32_t)text.size());
+        const char* word = words[gen.Next(sizeof(words) / sizeof(words[0]))];
+        uint32_t length = (uint32_t)std::strlen(word);
+        for (auto i = 0u; i < 2 * length; ++i) {
+            bool typing = i < length;
+            uint32_t offset = typing ? cursor + i : cursor + 2 * length - i - 1;
+            if (typing) {
+                text.insert(text.begin() + offset, word[i]);
+            }
+            else {
+                text.erase(offset, 1);
+            }
+            buffer.assign(text.begin(), text.end());
+            buffer.push_back('\0');
+
+            auto start = std::chrono::steady_clock::now();
+            Relex(&incremental, buffer.data(), (uint32_t)text.size(), offset, typing ? 0 : 1, typing ? 1 : 0);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            times.push_back(seconds);
+            numEdits++;
+        }
+    }
+
+    // the result has to be what lexing the final text from scratch gives
+    Lexer lexer;
+    tokens.resize(text.size() + 1);
+    Tokenize(&lexer, buffer.data(), (uint32_t)text.size(), tokens.data(), (uint32_t)(tokens.size() * sizeof(Token)), flags);
+    if (incremental.NumTokens() != lexer._numTokens) {
+        std::printf("Relex() kept %u tokens, Tokenize() produced %u\n", incremental.NumTokens(), lexer._numTokens);
+        return 1;
+    }
+    for (auto i = 0u; i < lexer._numTokens; ++i) {
+        Token token = incremental.GetToken(i);
+        if (!SameToken(token, tokens[i])) {
+            std::printf("token %u differs from Tokenize()\n", i);
+            return 1;
+        }
+    }
+
+    std::printf("%u lines, %zu KB, %u tokens\n", lexer._lineNumber, text.size() >> 10, lexer._numTokens);
+    std::printf("Tokenize() whole file   %10.1f us\n", fullSeconds * 1e6);
+    // the first keystroke after the cursor jumped moves the gaps there, that's the worst case
+    double totalSeconds = 0.0;
+    for (double seconds : times) {
+        totalSeconds += seconds;
+    }
+    std::sort(times.begin(), times.end());
+    std::printf("Relex() median          %10.2f us  average %.2f us, worst %.1f us over %u single character edits\n", times[times.size() / 2] * 1e6, totalSeconds / numEdits * 1e6, times.back() * 1e6, numEdits);
+    return 0;
+}
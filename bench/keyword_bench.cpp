@@ -0,0 +1,87 @@
+//  Compares keyword matching through the keyword arrays (linear scan) against a prebuilt KeywordTable.
+//
+//  Build: g++ -O2 -std=c++11 -I.. keyword_bench.cpp -o keyword_bench
+//  Usage: keyword_bench [identifiers per keyword count, default 200000]
+//
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace generic_lexer;
+
+int main(int argc, char** argv)
+{
+    const uint32_t keywordCounts[] = { 7, 16, 32, 64, 90, 128, 256, 500 };
+    const uint32_t numIdentifiers = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int NUM_RUNS = 5;
+
+    static KeywordTable table;
+    std::printf("%10s %14s %14s %10s\n", "keywords", "linear ns/id", "table ns/id", "speedup");
+    for (uint32_t numKeywords : keywordCounts) {
+        Generator gen(numKeywords);
+
+        std::vector<std::string> keywords;
+        while (keywords.size() < numKeywords) {
+            std::string word = gen.Letters(2, 10);
+            bool duplicate = false;
+            for (auto& keyword : keywords) {
+                duplicate |= keyword == word;
+            }
+            if (!duplicate) {
+                keywords.push_back(word);
+            }
+        }
+        std::vector<const char*> keywordStrings;
+        std::vector<TokenType> keywordTypes;
+        for (auto i = 0u; i < numKeywords; ++i) {
+            keywordStrings.push_back(keywords[i].c_str());
+            keywordTypes.push_back((TokenType)(DefaultToken::LAST_TYPE + i));
+        }
+        if (!table.Build(keywordStrings.data(), keywordTypes.data(), numKeywords)) {
+            std::printf("can't build a keyword table of %u keywords\n", numKeywords);
+            return 1;
+        }
+
+        // half keywords, half plain identifiers
+        std::string source;
+        for (auto i = 0u; i < numIdentifiers; ++i) {
+            source += (i & 1) ? keywords[gen.Next(numKeywords)] : gen.Letters(2, 10);
+            source += ' ';
+        }
+        std::vector<char> buffer(source.begin(), source.end());
+        buffer.push_back('\0');
+        std::vector<Token> tokens(numIdentifiers + 1);
+        uint32_t tokenBufferSize = (uint32_t)(tokens.size() * sizeof(Token));
+
+        double best[2] = { 1e30, 1e30 };
+        uint32_t checksum[2] = { 0, 0 };
+        for (int run = 0; run < NUM_RUNS; ++run) {
+            for (int useTable = 0; useTable < 2; ++useTable) {
+                Lexer lexer;
+                auto start = std::chrono::steady_clock::now();
+                if (useTable) {
+                    Tokenize(&lexer, buffer.data(), (uint32_t)source.size(), tokens.data(), tokenBufferSize, Lexer::Flags::NONE, &table);
+                }
+                else {
+                    Tokenize(&lexer, buffer.data(), (uint32_t)source.size(), tokens.data(), tokenBufferSize, Lexer::Flags::NONE, keywordStrings.data(), keywordTypes.data(), numKeywords);
+                }
+                double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                best[useTable] = ns < best[useTable] ? ns : best[useTable];
+                checksum[useTable] = 0;
+                for (auto i = 0u; i < lexer._numTokens; ++i) {
+                    checksum[useTable] = checksum[useTable] * 31 + tokens[i].type;
+                }
+            }
+        }
+        if (checksum[0] != checksum[1]) {
+            std::printf("keyword table disagrees with linear scan at %u keywords\n", numKeywords);
+            return 1;
+        }
+        std::printf("%10u %14.1f %14.1f %9.1fx\n", numKeywords, best[0] / numIdentifiers, best[1] / numIdentifiers, best[0] / best[1]);
+    }
+    return 0;
+}
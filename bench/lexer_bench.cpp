@@ -0,0 +1,328 @@
+//  Benchmark harness: lexes synthetic identifier-, comment-, numeric- and string-heavy corpora (or your own files) with every combination of
+//  Lexer::Flags and reports MB/s, tokens/s and ns/token. Built with GENERIC_LEXER_INSTRUMENT it also breaks the input down by lexing phase.
+//  Fails (exit code 1) when a run errors, drops below --min-mbps or falls more than --tolerance behind the --baseline recorded earlier with --record.
+//
+//  Build: g++ -O2 -std=c++11 -I.. lexer_bench.cpp -o lexer_bench       (add -DGENERIC_LEXER_INSTRUMENT for the phase breakdown)
+//  Usage: lexer_bench [--profiles identifier,comment,numeric,string,indented,operator] [--sizes 1K,1M,1G] [--flags all|0x3e,...] [--file path]...
+//                     [--min-time seconds] [--record file] [--baseline file] [--tolerance 0.25] [--min-mbps value]
+//
+//  Flags are printed as "mlsnc": skip multiline comments, skip single line comments, produce string literals, numeric literals, character constants.
+//
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace generic_lexer;
+
+/** Tokens that don't fit get drained like a consumer would, this keeps memory bounded for corpora up to a GB */
+static const uint32_t TOKEN_WINDOW = 1 << 20;
+
+/** A synthetic corpus profile, produces one line of code at a time */
+struct Profile
+{
+    const char*     name;
+    LineFunction    line;
+};
+
+static const Profile PROFILES[] = {
+    { "identifier", IdentifierLine },
+    { "comment", CommentLine },
+    { "numeric", NumericLine },
+    { "string", StringLine },
+    { "indented", IndentedLine },
+    { "operator", OperatorLine }
+};
+
+static bool LoadFile(Corpus* corpus, const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    corpus->data.assign((size_t)(size > 0 ? size : 0) + 1, '\0');
+    bool success = size >= 0 && std::fread(corpus->data.data(), 1, (size_t)size, file) == (size_t)size;
+    std::fclose(file);
+    corpus->size = (uint32_t)size;
+    return success;
+}
+
+static bool ParseSize(const std::string& text, uint64_t* outSize)
+{
+    char* end = nullptr;
+    uint64_t size = std::strtoull(text.c_str(), &end, 10);
+    switch (*end) {
+        case 'K': size <<= 10; ++end; break;
+        case 'M': size <<= 20; ++end; break;
+        case 'G': size <<= 30; ++end; break;
+        default: break;
+    }
+    *outSize = size;
+    return *end == '\0' && size > 0 && size < ((uint64_t)1 << 32) - 1;
+}
+
+static std::vector<std::string> Split(const char* list)
+{
+    std::vector<std::string> items;
+    std::string item;
+    for (const char* c = list; ; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+            item.clear();
+            if (*c == '\0') {
+                break;
+            }
+            continue;
+        }
+        item += *c;
+    }
+    return items;
+}
+
+static std::string FlagLetters(uint16_t flags)
+{
+    std::string letters = "-----";
+    letters[0] = flags & Lexer::Flags::SKIP_MULTILINE_COMMENTS ? 'm' : '-';
+    letters[1] = flags & Lexer::Flags::SKIP_SINGLE_LINE_COMMENTS ? 'l' : '-';
+    letters[2] = flags & Lexer::Flags::PRODUCE_STRING_LITERALS ? 's' : '-';
+    letters[3] = flags & Lexer::Flags::PRODUCE_NUMERIC_LITERALS ? 'n' : '-';
+    letters[4] = flags & Lexer::Flags::PRODUCE_CHARACTER_CONSTANTS ? 'c' : '-';
+    return letters;
+}
+
+/** Size and flags first, the corpus name (a file path, spaces and all) takes up the rest */
+static std::string BaselineKey(const Corpus& corpus, uint16_t flags)
+{
+    char key[64];
+    std::snprintf(key, sizeof(key), "%s 0x%02x ", corpus.sizeLabel.c_str(), (unsigned)flags);
+    return key + corpus.name;
+}
+
+/** Lexes the whole corpus, draining the token window whenever it runs full */
+static bool Lex(Lexer* lexer, Corpus* corpus, std::vector<Token>* window, uint16_t flags, const KeywordTable* keywords)
+{
+    bool done = Tokenize(lexer, corpus->data.data(), corpus->size, window->data(), (uint32_t)(window->size() * sizeof(Token)), Lexer::Flags(flags), keywords);
+    while (!done && lexer->_tokenSinkFull) {
+        lexer->_tokenStreamBufferOffset = 0;
+        done = Resume(lexer) == TOKENIZE_DONE;
+    }
+    return done;
+}
+
+struct Measurement
+{
+    double      seconds = 1e30;     // best run
+    uint32_t    numTokens = 0;
+    bool        success = true;
+};
+
+/** Best of as many runs as fit into minTime, at least three */
+static Measurement Measure(Corpus* corpus, std::vector<Token>* window, uint16_t flags, const KeywordTable* keywords, double minTime)
+{
+    Measurement measurement;
+    double total = 0.0;
+    for (int run = 0; measurement.success && (run < 3 || total < minTime); ++run) {
+        Lexer lexer;
+        auto start = std::chrono::steady_clock::now();
+        measurement.success = Lex(&lexer, corpus, window, flags, keywords);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        measurement.seconds = seconds < measurement.seconds ? seconds : measurement.seconds;
+        measurement.numTokens = lexer._numTokens;
+        total += seconds;
+    }
+    return measurement;
+}
+
+#ifdef GENERIC_LEXER_INSTRUMENT
+static void PrintCounters(const Lexer::Counters& counters, uint32_t size)
+{
+    const uint64_t phases[] = {
+        counters.whitespaceBytes, counters.lineCommentBytes, counters.multilineCommentBytes, counters.identifierBytes,
+        counters.numericBytes, counters.stringBytes, counters.operatorBytes
+    };
+    const char* names[] = { "whitespace", "line comments", "block comments", "identifiers", "numbers", "strings", "operators" };
+    uint64_t counted = 0;
+    std::printf("    ");
+    for (auto i = 0u; i < sizeof(phases) / sizeof(phases[0]); ++i) {
+        std::printf("%s %.1f%%  ", names[i], 100.0 * phases[i] / size);
+        counted += phases[i];
+    }
+    std::printf("other %.1f%%\n", counted < size ? 100.0 * (size - counted) / size : 0.0);
+    uint64_t lookups = counters.keywordHits + counters.keywordMisses;
+    std::printf("    %llu keyword lookups over %llu bytes, %.1f%% hits\n", (unsigned long long)lookups, (unsigned long long)counters.keywordLookupBytes,
+        lookups ? 100.0 * counters.keywordHits / lookups : 0.0);
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> profileNames = { "identifier", "comment", "numeric", "string" };
+    std::vector<std::string> sizeLabels = { "1K", "1M" };
+    std::vector<std::string> files;
+    std::vector<uint16_t> flagSets;
+    double minTime = 0.1;
+    double tolerance = 0.25;
+    double minMbps = 0.0;
+    const char* recordPath = nullptr;
+    const char* baselinePath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::printf("%s needs a value\n", arg.c_str());
+            return 2;
+        }
+        ++i;
+        if (arg == "--profiles") profileNames = Split(value);
+        else if (arg == "--sizes") sizeLabels = Split(value);
+        else if (arg == "--file") files.push_back(value);
+        else if (arg == "--min-time") minTime = std::atof(value);
+        else if (arg == "--tolerance") tolerance = std::atof(value);
+        else if (arg == "--min-mbps") minMbps = std::atof(value);
+        else if (arg == "--record") recordPath = value;
+        else if (arg == "--baseline") baselinePath = value;
+        else if (arg == "--flags") {
+            if (std::strcmp(value, "all") != 0) {
+                for (const std::string& flags : Split(value)) {
+                    flagSets.push_back((uint16_t)std::strtoul(flags.c_str(), nullptr, 0));
+                }
+            }
+        }
+        else {
+            std::printf("unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (flagSets.empty()) {
+        for (uint16_t flags = 0; flags < 32; ++flags) {
+            flagSets.push_back((uint16_t)(flags << 1));     // every combination of the five flag bits
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselinePath) {
+        FILE* file = std::fopen(baselinePath, "r");
+        if (!file) {
+            std::printf("can't read baseline %s\n", baselinePath);
+            return 2;
+        }
+        // one "<MB/s> <key>" per line
+        char line[4096];
+        while (std::fgets(line, sizeof(line), file)) {
+            double mbps;
+            int keyStart = 0;
+            if (std::sscanf(line, "%lf %n", &mbps, &keyStart) != 1 || keyStart == 0) {
+                continue;
+            }
+            std::string key = line + keyStart;
+            while (!key.empty() && (key.back() == '\n' || key.back() == '\r')) {
+                key.pop_back();
+            }
+            baseline[key] = mbps;
+        }
+        std::fclose(file);
+    }
+    FILE* record = recordPath ? std::fopen(recordPath, "w") : nullptr;
+    if (recordPath && !record) {
+        std::printf("can't write %s\n", recordPath);
+        return 2;
+    }
+
+    static KeywordTable keywordTable;
+    if (!keywordTable.Build(KEYWORDS, KeywordTypes(), NUM_KEYWORDS)) {
+        std::printf("can't build the keyword table\n");
+        return 1;
+    }
+
+    std::vector<Corpus> corpora;
+    for (const std::string& profileName : profileNames) {
+        const Profile* profile = nullptr;
+        for (const Profile& candidate : PROFILES) {
+            profile = profileName == candidate.name ? &candidate : profile;
+        }
+        if (!profile) {
+            std::printf("unknown profile %s\n", profileName.c_str());
+            return 2;
+        }
+        for (const std::string& sizeLabel : sizeLabels) {
+            uint64_t size = 0;
+            if (!ParseSize(sizeLabel, &size)) {
+                std::printf("bad size %s, sizes go from 1 byte to 4G\n", sizeLabel.c_str());
+                return 2;
+            }
+            corpora.push_back(Corpus());
+            corpora.back().name = profile->name;
+            corpora.back().sizeLabel = sizeLabel;
+            Generate(&corpora.back(), profile->line, size);
+        }
+    }
+    for (const std::string& path : files) {
+        corpora.push_back(Corpus());
+        corpora.back().name = path;
+        corpora.back().sizeLabel = "file";
+        if (!LoadFile(&corpora.back(), path.c_str())) {
+            std::printf("can't read %s\n", path.c_str());
+            return 2;
+        }
+    }
+
+    bool failed = false;
+    std::printf("%-12s %6s %10s  %-5s %10s %12s %9s\n", "corpus", "size", "bytes", "flags", "MB/s", "Mtokens/s", "ns/token");
+    for (Corpus& corpus : corpora) {
+        std::vector<Token> window(corpus.size + 1 < TOKEN_WINDOW ? corpus.size + 1 : TOKEN_WINDOW);
+        for (uint16_t flags : flagSets) {
+            Measurement measurement = Measure(&corpus, &window, flags, &keywordTable, minTime);
+            auto expected = baseline.find(BaselineKey(corpus, flags));
+            double threshold = expected != baseline.end() ? expected->second * (1.0 - tolerance) : 0.0;
+            threshold = threshold > minMbps ? threshold : minMbps;
+            if (measurement.success && corpus.size / measurement.seconds / 1e6 < threshold) {
+                // give a slow row a second, longer chance before failing, a busy machine shouldn't make the run flaky
+                Measurement again = Measure(&corpus, &window, flags, &keywordTable, 4 * minTime);
+                measurement.seconds = again.seconds < measurement.seconds ? again.seconds : measurement.seconds;
+            }
+
+            double mbps = corpus.size / measurement.seconds / 1e6;
+            uint32_t numTokens = measurement.numTokens;
+            std::printf("%-12s %6s %10u  %s %10.1f %12.1f %9.2f", corpus.name.c_str(), corpus.sizeLabel.c_str(), corpus.size, FlagLetters(flags).c_str(),
+                mbps, numTokens / measurement.seconds / 1e6, measurement.seconds * 1e9 / numTokens);
+            if (!measurement.success) {
+                std::printf("  lexing failed");
+                failed = true;
+            }
+            else if (mbps < minMbps) {
+                std::printf("  below %.1f MB/s", minMbps);
+                failed = true;
+            }
+            else if (mbps < threshold) {
+                std::printf("  REGRESSION, baseline %.1f MB/s", expected->second);
+                failed = true;
+            }
+            std::printf("\n");
+            if (record && measurement.success) {
+                std::fprintf(record, "%f %s\n", mbps, BaselineKey(corpus, flags).c_str());
+            }
+
+#ifdef GENERIC_LEXER_INSTRUMENT
+            // one more run to read the counters from, the timed ones start from scratch every time
+            Lexer lexer;
+            Lex(&lexer, &corpus, &window, flags, &keywordTable);
+            PrintCounters(lexer._counters, corpus.size);
+#endif
+        }
+    }
+    if (record) {
+        std::fclose(record);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+//  Throughput on operator-dense code, once with the default operators and once with a larger C-like operator table built the way a dialect would.
+//  Both are compared against the punctuation switch the operator tables replaced, lexing the same tokens as the default table.
+//  Expect the default table to come out level with the switch (0.98-1.18x over a number of runs), the tables aren't there for speed.
+//
+//  Build: g++ -O2 -std=c++14 -I.. operator_bench.cpp -o operator_bench
+//
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace generic_lexer;
+
+enum DialectToken : TokenType
+{
+    SHIFT_LEFT = DefaultToken::LAST_TYPE,
+    SHIFT_RIGHT,
+    SHIFT_LEFT_ASSIGN,
+    SHIFT_RIGHT_ASSIGN,
+    INCREMENT,
+    DECREMENT,
+    PLUS_ASSIGN,
+    MINUS_ASSIGN,
+    STAR_ASSIGN,
+    SLASH_ASSIGN,
+    AMPERSAND_ASSIGN,
+    PIPE_ASSIGN,
+    CARET_ASSIGN,
+    ELLIPSIS,
+    PERCENT,
+    PERCENT_ASSIGN,
+    SPACESHIP
+};
+
+static GENERIC_LEXER_CONSTEXPR14 const OperatorSpec DialectOperators[] = {
+    { "(", DefaultToken::PARENTHESES_OPEN }, { ")", DefaultToken::PARENTHESES_CLOSE },
+    { "[", DefaultToken::SQUARE_BRACKET_OPEN }, { "]", DefaultToken::SQUARE_BRACKET_CLOSE },
+    { "{", DefaultToken::CURLY_BRACES_OPEN }, { "}", DefaultToken::CURLY_BRACES_CLOSE },
+    { ".", DefaultToken::DOT }, { "...", ELLIPSIS }, { ",", DefaultToken::COMMA }, { ":", DefaultToken::COLON }, { "::", DefaultToken::DOUBLE_COLON },
+    { ";", DefaultToken::SEMICOLON }, { "!", DefaultToken::EXCLAMATION }, { "!=", DefaultToken::NOT_EQUALS }, { "?", DefaultToken::QUESTION_MARK },
+    { "+", DefaultToken::PLUS }, { "++", INCREMENT }, { "+=", PLUS_ASSIGN }, { "-", DefaultToken::MINUS }, { "--", DECREMENT }, { "-=", MINUS_ASSIGN },
+    { "->", DefaultToken::ARROW }, { "*", DefaultToken::STAR }, { "*=", STAR_ASSIGN }, { "/", DefaultToken::SLASH }, { "/=", SLASH_ASSIGN },
+    { "%", PERCENT }, { "%=", PERCENT_ASSIGN }, { "=", DefaultToken::EQUALS }, { "==", DefaultToken::DOUBLE_EQUALS },
+    { "<", DefaultToken::LESS }, { "<=", DefaultToken::LEQUALS }, { "<<", SHIFT_LEFT }, { "<<=", SHIFT_LEFT_ASSIGN }, { "<=>", SPACESHIP },
+    { ">", DefaultToken::GREATER }, { ">=", DefaultToken::GEQUALS }, { ">>", SHIFT_RIGHT }, { ">>=", SHIFT_RIGHT_ASSIGN },
+    { "&", DefaultToken::AMPERSAND }, { "&&", DefaultToken::DOUBLE_AMPERSAND }, { "&=", AMPERSAND_ASSIGN },
+    { "|", DefaultToken::PIPE }, { "||", DefaultToken::DOUBLE_PIPE }, { "|=", PIPE_ASSIGN },
+    { "^", DefaultToken::CARET }, { "^^", DefaultToken::DOUBLE_CARET }, { "^=", CARET_ASSIGN }, { "~", DefaultToken::TILDE },
+    { "@", DefaultToken::AT }, { "#", DefaultToken::POUND }, { "\\", DefaultToken::BACKSLASH }
+};
+static GENERIC_LEXER_CONSTEXPR14 const OperatorDfa DialectOperatorDfa(DialectOperators);
+
+/**
+ * The switch over the first character ParseToken() used before the operator tables, with the default table's two character operators
+ * added (the switch only knew a few of them) so both produce the same tokens. Returns false for anything that isn't punctuation.
+ */
+static bool ReferenceParseOperator(Lexer* context)
+{
+    char* text = context->_currentPos;
+    TokenType type;
+    uint32_t length = 1;
+    switch (text[0]) {
+        case '(': type = DefaultToken::PARENTHESES_OPEN; break;
+        case ')': type = DefaultToken::PARENTHESES_CLOSE; break;
+        case '[': type = DefaultToken::SQUARE_BRACKET_OPEN; break;
+        case ']': type = DefaultToken::SQUARE_BRACKET_CLOSE; break;
+        case '{': type = DefaultToken::CURLY_BRACES_OPEN; break;
+        case '}': type = DefaultToken::CURLY_BRACES_CLOSE; break;
+        case '.': type = DefaultToken::DOT; break;
+        case ',': type = DefaultToken::COMMA; break;
+        case ';': type = DefaultToken::SEMICOLON; break;
+        case '?': type = DefaultToken::QUESTION_MARK; break;
+        case '+': type = DefaultToken::PLUS; break;
+        case '*': type = DefaultToken::STAR; break;
+        case '/': type = DefaultToken::SLASH; break;
+        case '\\': type = DefaultToken::BACKSLASH; break;
+        case '~': type = DefaultToken::TILDE; break;
+        case '@': type = DefaultToken::AT; break;
+        case '#': type = DefaultToken::POUND; break;
+        case '"': type = DefaultToken::QUOTATION_MARK; break;
+        case '\'': type = DefaultToken::APOSTROPHE; break;
+        case ':':
+            type = DefaultToken::COLON;
+            if (text[1] == ':') {
+                type = DefaultToken::DOUBLE_COLON;
+                length = 2;
+            }
+            break;
+        case '!':
+            type = DefaultToken::EXCLAMATION;
+            if (text[1] == '=') {
+                type = DefaultToken::NOT_EQUALS;
+                length = 2;
+            }
+            break;
+        case '-':
+            type = DefaultToken::MINUS;
+            if (text[1] == '>') {
+                type = DefaultToken::ARROW;
+                length = 2;
+            }
+            break;
+        case '=':
+            type = DefaultToken::EQUALS;
+            if (text[1] == '=') {
+                type = DefaultToken::DOUBLE_EQUALS;
+                length = 2;
+            }
+            break;
+        case '<':
+            type = DefaultToken::LESS;
+            if (text[1] == '=') {
+                type = DefaultToken::LEQUALS;
+                length = 2;
+            }
+            break;
+        case '>':
+            type = DefaultToken::GREATER;
+            if (text[1] == '=') {
+                type = DefaultToken::GEQUALS;
+                length = 2;
+            }
+            break;
+        case '&':
+            type = DefaultToken::AMPERSAND;
+            if (text[1] == '&') {
+                type = DefaultToken::DOUBLE_AMPERSAND;
+                length = 2;
+            }
+            break;
+        case '|':
+            type = DefaultToken::PIPE;
+            if (text[1] == '|') {
+                type = DefaultToken::DOUBLE_PIPE;
+                length = 2;
+            }
+            break;
+        case '^':
+            type = DefaultToken::CARET;
+            if (text[1] == '^') {
+                type = DefaultToken::DOUBLE_CARET;
+                length = 2;
+            }
+            break;
+        default:
+            return false;
+    }
+    WriteToken(context, type, text, length);
+    context->AdvanceTo(text + length, 0);
+    return true;
+}
+
+/** RunLexer() with the switch in front of ParseToken(), only for Lexer::Flags::NONE where punctuation never starts a comment or literal */
+static void ReferenceTokenize(Lexer* context, char* buffer, uint32_t bufferSize, Token* tokens, uint32_t tokenBufferSize)
+{
+    BeginBuffer(context, buffer, bufferSize, Lexer::Flags::NONE);
+    context->_tokenStreamBuffer = tokens;
+    context->_tokenStreamBufferSize = tokenBufferSize;
+    for (;;) {
+        EatWhitespaces(context);
+        if (IsEoF(context->GetChar())) {
+            break;
+        }
+        Lexer::State state = context->SaveState();
+        if (!ReferenceParseOperator(context)) {
+            ParseToken(context);
+        }
+        if (context->_tokenSinkFull) {
+            context->RestoreState(state);
+            return;
+        }
+    }
+    WriteEoFToken(context);
+}
+
+static uint32_t Checksum(const std::vector<Token>& tokens, uint32_t numTokens)
+{
+    uint32_t checksum = 0;
+    for (auto i = 0u; i < numTokens; ++i) {
+        checksum = checksum * 31 + tokens[i].type * 7 + (uint32_t)tokens[i].text.length;
+    }
+    return checksum;
+}
+
+int main()
+{
+    const size_t CORPUS_SIZE = 16 << 20;
+    const int NUM_RUNS = 5;
+
+    if (!DialectOperatorDfa._valid) {
+        std::printf("dialect operators don't fit the DFA limits\n");
+        return 1;
+    }
+
+    Corpus corpus;
+    Generate(&corpus, OperatorLine, CORPUS_SIZE);
+    std::vector<Token> tokens(corpus.size + 1);
+
+    // the tables take turns run by run, so a noisy stretch doesn't end up in just one of them
+    struct { const char* name; const OperatorDfa* operators; double best; uint32_t numTokens; uint32_t checksum; } tables[] = {
+        { "switch (reference)", nullptr, 1e30, 0, 0 }, { "default operators", &DefaultOperatorDfa, 1e30, 0, 0 }, { "dialect operators", &DialectOperatorDfa, 1e30, 0, 0 }
+    };
+    uint32_t tokenBufferSize = (uint32_t)(tokens.size() * sizeof(Token));
+    for (int run = 0; run < NUM_RUNS; ++run) {
+        for (auto& table : tables) {
+            Lexer lexer;
+            auto start = std::chrono::steady_clock::now();
+            if (table.operators) {
+                lexer._operators = table.operators;
+                Tokenize(&lexer, corpus.data.data(), corpus.size, tokens.data(), tokenBufferSize, Lexer::Flags::NONE);
+            }
+            else {
+                ReferenceTokenize(&lexer, corpus.data.data(), corpus.size, tokens.data(), tokenBufferSize);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            table.best = seconds < table.best ? seconds : table.best;
+            table.numTokens = lexer._numTokens;
+            table.checksum = Checksum(tokens, lexer._numTokens);
+        }
+    }
+    if (tables[0].numTokens != tables[1].numTokens || tables[0].checksum != tables[1].checksum) {
+        std::printf("the switch and the default operator table disagree\n");
+        return 1;
+    }
+    for (auto& table : tables) {
+        std::printf("%-20s %8.1f MB/s %7.1f M tokens/s %6.2f ns/token %6.2fx\n", table.name, corpus.size / table.best / 1e6, table.numTokens / table.best / 1e6,
+            table.best * 1e9 / table.numTokens, tables[0].best / table.best);
+    }
+    return 0;
+}
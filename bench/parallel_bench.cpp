@@ -0,0 +1,93 @@
+//  TokenizeParallel() against Tokenize() on a large mixed corpus: checks that both produce exactly the same tokens and reports the speedup per thread count.
+//
+//  Build: g++ -O2 -std=c++11 -pthread -I.. parallel_bench.cpp -o parallel_bench
+//  Usage: parallel_bench [corpus size in MB, default 64]
+//
+#define GENERIC_LEXER_ENABLE_THREADS
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace generic_lexer;
+
+static bool SameTokens(const std::vector<Token>& a, const std::vector<Token>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!SameToken(a[i], b[i])) {
+            std::printf("first difference at token %zu\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t corpusSize = (argc > 1 ? std::atoi(argv[1]) : 64) << 20;
+    const int NUM_RUNS = 3;
+    const Lexer::Flags FLAG_SETS[] = { Lexer::Flags::NONE, Lexer::Flags::SKIP_ALL_COMMENTS, Lexer::Flags(Lexer::Flags::SKIP_ALL_COMMENTS | Lexer::Flags::PRODUCE_STRING_LITERALS | Lexer::Flags::PRODUCE_NUMERIC_LITERALS | Lexer::Flags::PRODUCE_CHARACTER_CONSTANTS) };
+
+    Corpus corpus;
+    Generate(&corpus, MixedLine, corpusSize);
+    char* buffer = corpus.data.data();
+
+    uint32_t maxThreads = std::thread::hardware_concurrency();
+    maxThreads = maxThreads < 2 ? 2 : maxThreads;   // always run the fix-up path at least once
+    std::printf("%u KB, %u hardware threads\n", corpus.size >> 10, std::thread::hardware_concurrency());
+
+    for (Lexer::Flags flags : FLAG_SETS) {
+        std::vector<Token> expected(corpus.size + 1);
+        double sequentialSeconds = 1e30;
+        for (int run = 0; run < NUM_RUNS; ++run) {
+            Lexer lexer;
+            auto start = std::chrono::steady_clock::now();
+            if (!Tokenize(&lexer, buffer, corpus.size, expected.data(), (uint32_t)(expected.size() * sizeof(Token)), flags)) {
+                std::printf("sequential Tokenize() failed\n");
+                return 1;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            sequentialSeconds = seconds < sequentialSeconds ? seconds : sequentialSeconds;
+            expected.resize(lexer._numTokens);
+        }
+        std::printf("flags 0x%02x: %zu tokens, sequential %8.1f MB/s\n", (unsigned)flags, expected.size(), corpus.size / sequentialSeconds / 1e6);
+
+        for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+            std::vector<RecyclingAllocator> heaps(numThreads);
+            std::vector<Allocator*> allocators;
+            for (RecyclingAllocator& heap : heaps) {
+                allocators.push_back(&heap);
+            }
+            double best = 1e30;
+            for (int run = 0; run <= NUM_RUNS; ++run) {     // the first run only warms up the allocators
+                for (RecyclingAllocator& heap : heaps) {
+                    heap.Rewind();
+                }
+                ArenaTokenSink result;
+                auto start = std::chrono::steady_clock::now();
+                if (!TokenizeParallel(buffer, corpus.size, &result, allocators.data(), numThreads, flags)) {
+                    std::printf("TokenizeParallel() failed\n");
+                    return 1;
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = run > 0 && seconds < best ? seconds : best;
+
+                std::vector<Token> tokens((size_t)result._numTokens);
+                result.CopyTo(tokens.data());
+                if (!SameTokens(tokens, expected)) {
+                    std::printf("%u threads: result differs from Tokenize()\n", numThreads);
+                    return 1;
+                }
+            }
+            std::printf("  %2u threads %8.1f MB/s  %5.2fx\n", numThreads, corpus.size / best / 1e6, sequentialSeconds / best);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+//  Throughput of the scan kernels on a whitespace- and comment-heavy corpus, once per kernel level and once with the header as it was before
+//  the kernels (bench/reference/GENERIC_LEXER.H, unchanged, in its own namespace), the baseline every level is compared against.
+//
+//  Build: g++ -O2 -std=c++11 -I.. scan_bench.cpp -o scan_bench
+//
+#include <cstddef>      // the old header uses size_t without including it
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"     // ParseStringLiteral() falls off its end, the corpus has no string literals
+#endif
+#define generic_lexer reference_lexer
+#include "reference/GENERIC_LEXER.H"
+#undef generic_lexer
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include "bench_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace generic_lexer;
+
+static double TimeReference(const Corpus& corpus, std::vector<reference_lexer::Token>* tokens, uint32_t* numTokens)
+{
+    reference_lexer::Lexer lexer;
+    auto start = std::chrono::steady_clock::now();
+    reference_lexer::Tokenize(&lexer, (char*)corpus.data.data(), corpus.size, tokens->data(), (uint32_t)(tokens->size() * sizeof(reference_lexer::Token)),
+        reference_lexer::Lexer::Flags::SKIP_ALL_COMMENTS);
+    *numTokens = lexer._numTokens;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double TimeKernels(const Corpus& corpus, ScanKernels* kernels, std::vector<Token>* tokens, uint32_t* numTokens)
+{
+    Lexer lexer;
+    lexer._scanKernels = kernels;
+    auto start = std::chrono::steady_clock::now();
+    Tokenize(&lexer, (char*)corpus.data.data(), corpus.size, tokens->data(), (uint32_t)(tokens->size() * sizeof(Token)), Lexer::Flags::SKIP_ALL_COMMENTS);
+    *numTokens = lexer._numTokens;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    const size_t CORPUS_SIZE = 16 << 20;
+    const int NUM_RUNS = 9;
+
+    // no underscores in it, the old header's ParseIdentifier() never gets past one
+    Corpus corpus;
+    Generate(&corpus, IndentedLine, CORPUS_SIZE);
+    std::vector<Token> tokens(corpus.size + 1);
+    std::vector<reference_lexer::Token> referenceTokens(corpus.size + 1);
+
+    const char* levelNames[] = { "scalar", "sse2", "avx2" };
+    ScanKernels kernels[ScanKernels::AVX2 + 1];
+    bool supported[ScanKernels::AVX2 + 1];
+    for (int level = ScanKernels::SCALAR; level <= ScanKernels::AVX2; ++level) {
+        supported[level] = kernels[level].Select((ScanKernels::Level)level) == level;
+    }
+
+    // the baseline and the levels take turns, so a noisy stretch on the machine doesn't end up in one of them only
+    double referenceSeconds = 1e30;
+    double seconds[ScanKernels::AVX2 + 1] = { 1e30, 1e30, 1e30 };
+    uint32_t numReferenceTokens = 0;
+    for (int run = 0; run < NUM_RUNS; ++run) {
+        referenceSeconds = std::min(referenceSeconds, TimeReference(corpus, &referenceTokens, &numReferenceTokens));
+        for (int level = ScanKernels::SCALAR; level <= ScanKernels::AVX2; ++level) {
+            if (!supported[level]) {
+                continue;
+            }
+            uint32_t numTokens = 0;
+            seconds[level] = std::min(seconds[level], TimeKernels(corpus, &kernels[level], &tokens, &numTokens));
+
+            // same tokens as the old header, token type numbers didn't change
+            bool same = numTokens == numReferenceTokens;
+            for (auto i = 0u; same && i < numTokens; ++i) {
+                const reference_lexer::Token& reference = referenceTokens[i];
+                same = tokens[i].type == reference.type && tokens[i].text.buffer == reference.text.buffer && tokens[i].text.length == reference.text.length
+                    && tokens[i].lineNumber == reference.lineNumber;
+            }
+            if (!same) {
+                std::printf("%s kernels don't produce the tokens the old header does (%u tokens against %u)\n", levelNames[level], numTokens, numReferenceTokens);
+                return 1;
+            }
+        }
+    }
+
+    std::printf("%-10s %13s %10s %12s\n", "kernels", "", "vs scalar", "vs baseline");
+    std::printf("%-10s %8.1f MB/s\n", "baseline", corpus.size / referenceSeconds / 1e6);
+    for (int level = ScanKernels::SCALAR; level <= ScanKernels::AVX2; ++level) {
+        if (!supported[level]) {
+            std::printf("%-10s not supported\n", levelNames[level]);
+            continue;
+        }
+        std::printf("%-10s %8.1f MB/s %9.2fx %11.2fx\n", levelNames[level], corpus.size / seconds[level] / 1e6, seconds[ScanKernels::SCALAR] / seconds[level],
+            referenceSeconds / seconds[level]);
+    }
+    return 0;
+}